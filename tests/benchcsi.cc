@@ -0,0 +1,692 @@
+/******************************************************************************/
+/*                                                                            */
+/* (C) Copyright 2021 CERN.                                                   */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* In applying this licence, CERN does not waive the privileges and           */
+/* immunities granted to it by virtue of its status as an Intergovernmental   */
+/* Organization or submit itself to any jurisdiction.                         */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+// bench_csi: throughput and latency of the XrdOssCsi plugin compared with the
+// bare default oss. Each case runs a number of threads, each with its own
+// XrdOssDF on a shared file and its own non-overlapping region of that file.
+// With -S all threads use the same region instead, as test_concurrent does,
+// so that they contend for the page range locks of a single hot file. Check
+// that the -S results from an optimised build scale sensibly over e.g. 1, 4
+// and 16 threads before using them as a baseline for range lock changes.
+// The Open case times open and close of an existing file, by default a
+// different file per thread; with -S all threads open the same file. The
+// Create case times creating and closing new empty files, each in its own
+// directory which is made beforehand and is not timed; files and
+// directories are removed after the measurement. Pass -p "prefix=/dir" so
+// that every create also has to make a new mirrored tag file directory.
+// The ReadV case reads a request as a vector of small chunks with gaps
+// between them.
+//
+// Numbers are only meaningful from an optimised build: configure with
+// -DBUILD_BENCH=1 (and without BUILD_TEST, whose build is compiled with -O0
+// and coverage instrumentation) and run against the plugin from that build.
+//
+// usage: bench_csi [-o ops] [-s sizes] [-t threads] [-a aligned|unaligned|both]
+//                  [-x csi,base] [-m MiB per case] [-n min iterations]
+//                  [-N open/create iterations] [-f file]
+//                  [-p plugin parameters] [-S]
+
+#include "XrdOuc/XrdOucCRC.hh"
+#include "XrdOss/XrdOss.hh"
+#include "XrdOss/XrdOssDefaultSS.hh"
+#include "XrdOuc/XrdOucEnv.hh"
+#include "XrdOuc/XrdOucIOVec.hh"
+#include "XrdSys/XrdSysLogger.hh"
+#include "XrdVersion.hh"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define TMPFN "/tmp/xrdosscsi_bench"
+
+namespace {
+
+const size_t PGSZ = 4096;
+
+// page offset used for the unaligned cases: both the start and the
+// end of a multi-page request then fall part way through a page
+const size_t UNALIGNED_OFF = 2049;
+
+// chunk length used by ReadV, placed every 2*RV_CHUNK bytes
+const size_t RV_CHUNK = 1024;
+
+enum OpType { opWrite, opRead, opPgWrite, opPgRead, opReadV, opOpen,
+              opCreate };
+
+struct BenchOp {
+  const char *name;
+  OpType      type;
+  bool        csvec;
+  uint64_t    opts;
+};
+
+// writes are listed before reads so that the reads see data (and tags)
+// written by the preceding cases
+const BenchOp benchOps[] = {
+  { "Write",           opWrite,   false, 0 },
+  { "pgWrite/Verify",  opPgWrite, true,  XrdOssDF::Verify },
+  { "pgWrite/doCalc",  opPgWrite, true,  XrdOssDF::doCalc },
+  { "pgWrite/nocsvec", opPgWrite, false, 0 },
+  { "Read",            opRead,    false, 0 },
+  { "pgRead/Verify",   opPgRead,  true,  XrdOssDF::Verify },
+  { "pgRead",          opPgRead,  true,  0 },
+  { "pgRead/nocsvec",  opPgRead,  false, XrdOssDF::Verify },
+  { "ReadV",           opReadV,   false, 0 },
+  { "Open",            opOpen,    false, 0 },
+  { "Create",          opCreate,  false, 0 }
+};
+
+struct BenchConfig {
+  std::vector<const BenchOp*> ops;
+  std::vector<size_t>         sizes;
+  std::vector<int>            threads;
+  std::vector<size_t>         pageoffs;
+  bool                        runCsi;
+  bool                        runBase;
+  bool                        shared;
+  size_t                      budget;
+  size_t                      minIter;
+  size_t                      metaIter;
+  std::string                 fn;
+  std::string                 params;
+};
+
+struct ThreadResult {
+  std::vector<double>                   lat;
+  size_t                                bytes;
+  int                                   err;
+  size_t                                files;
+  std::chrono::steady_clock::time_point end;
+};
+
+// number of checksums pgRead/pgWrite use for len bytes at off
+size_t nCsvec(off_t off, size_t len) {
+  const size_t p_off = off % PGSZ;
+  const size_t p_alen = (p_off > 0) ? std::min(PGSZ - p_off, len) : 0;
+  return ((p_alen > 0) ? 1 : 0) + (len - p_alen + PGSZ - 1) / PGSZ;
+}
+
+void calcCsvec(const uint8_t *buf, off_t off, size_t len, uint32_t *csvec) {
+  const size_t p_off = off % PGSZ;
+  const size_t p_alen = (p_off > 0) ? std::min(PGSZ - p_off, len) : 0;
+  if (p_alen > 0) {
+    XrdOucCRC::Calc32C((void*)buf, p_alen, csvec);
+    csvec++;
+  }
+  if (len > p_alen) {
+    XrdOucCRC::Calc32C((void*)&buf[p_alen], len - p_alen, csvec);
+  }
+}
+
+// cases which do not transfer data, run once per thread count
+bool isMeta(const BenchOp *op) {
+  return op->type == opOpen || op->type == opCreate;
+}
+
+// distance between the regions used by consecutive threads
+off_t regionSpan(size_t size) {
+  return ((UNALIGNED_OFF + size + PGSZ - 1) / PGSZ + 1) * PGSZ;
+}
+
+size_t parseSize(const char *s) {
+  char *ep;
+  unsigned long long v = strtoull(s, &ep, 10);
+  switch(*ep) {
+    case 'k': case 'K': v <<= 10; break;
+    case 'm': case 'M': v <<= 20; break;
+    case 'g': case 'G': v <<= 30; break;
+    default: break;
+  }
+  return v;
+}
+
+std::vector<std::string> splitList(const char *s) {
+  std::vector<std::string> v;
+  std::string str(s);
+  size_t p = 0;
+  while(p <= str.size()) {
+    const size_t q = std::min(str.find(',', p), str.size());
+    if (q > p) v.push_back(str.substr(p, q - p));
+    p = q + 1;
+  }
+  return v;
+}
+
+std::string sizeStr(size_t s) {
+  char buf[32];
+  if (s >= (1<<20) && s % (1<<20) == 0) {
+    snprintf(buf, sizeof(buf), "%zuM", s >> 20);
+  } else if (s >= 1024 && s % 1024 == 0) {
+    snprintf(buf, sizeof(buf), "%zuK", s >> 10);
+  } else {
+    snprintf(buf, sizeof(buf), "%zu", s);
+  }
+  return buf;
+}
+
+class Bench {
+public:
+  Bench(XrdOss *oss, const char *name, const BenchConfig &cfg) :
+    m_oss(oss), m_name(name), m_cfg(cfg) { }
+
+  int run();
+
+private:
+  int  populate(size_t size, int nthr);
+  int  populateMeta(int nthr);
+  void cleanupMeta(int nthr);
+  void cleanupCreate(int idx, size_t ndirs, size_t nfiles);
+  std::string createDir(int idx, size_t i);
+  std::string metaFn(int idx);
+  std::string createFn(int idx, size_t i);
+  int  runCase(const BenchOp *op, size_t size, size_t pageoff, int nthr);
+  void thread(const BenchOp *op, size_t size, size_t pageoff, int idx,
+              size_t niter, ThreadResult *res);
+  void metaThread(const BenchOp *op, int idx, size_t niter,
+                  ThreadResult *res);
+
+  XrdOss            *m_oss;
+  const char        *m_name;
+  const BenchConfig &m_cfg;
+  XrdOucEnv          m_env;
+  std::atomic<int>   m_ready;
+  std::atomic<bool>  m_go;
+};
+
+void Bench::thread(const BenchOp *op, size_t size, size_t pageoff, int idx,
+                   size_t niter, ThreadResult *res) {
+  res->bytes = 0;
+  res->err = 0;
+  res->files = 0;
+  res->lat.reserve(niter);
+
+  std::string tid = "benchtid" + std::to_string((long long)idx);
+  std::unique_ptr<XrdOssDF> file(m_oss->newFile(tid.c_str()));
+  std::unique_ptr<uint8_t[]> buf(new uint8_t[size]);
+  const off_t off = (m_cfg.shared ? 0 : idx * regionSpan(size)) + pageoff;
+  const size_t ncs = nCsvec(off, size);
+  std::unique_ptr<uint32_t[]> csvec(new uint32_t[ncs]);
+
+  uint32_t x = 1 + idx;
+  for(size_t i=0;i<size;i++) {
+    x = (48271ULL * x) % 0x7fffffff;
+    buf[i] = x;
+  }
+  calcCsvec(&buf[0], off, size, &csvec[0]);
+
+  size_t expect = size;
+  std::vector<XrdOucIOVec> iov;
+  if (op->type == opReadV) {
+    const size_t nch = std::max((size_t)1, size / (2*RV_CHUNK));
+    const size_t clen = std::min(size, RV_CHUNK);
+    iov.resize(nch);
+    for(size_t i=0;i<nch;i++) {
+      iov[i].offset = off + i*2*RV_CHUNK;
+      iov[i].size = clen;
+      iov[i].info = 0;
+      iov[i].data = (char*)&buf[i*clen];
+    }
+    expect = nch * clen;
+  }
+
+  int ret = file->Open(m_cfg.fn.c_str(), O_RDWR, 0600, m_env);
+  if (ret != XrdOssOK) res->err = ret;
+
+  m_ready++;
+  while(!m_go) std::this_thread::yield();
+  if (res->err) {
+    res->end = std::chrono::steady_clock::now();
+    return;
+  }
+
+  for(size_t i=0;i<niter;i++) {
+    uint32_t *const csp = op->csvec ? &csvec[0] : NULL;
+    const std::chrono::steady_clock::time_point t0 =
+                                          std::chrono::steady_clock::now();
+    ssize_t r = 0;
+    switch(op->type) {
+      case opWrite:
+        r = file->Write(&buf[0], off, size);
+        break;
+      case opRead:
+        r = file->Read(&buf[0], off, size);
+        break;
+      case opPgWrite:
+        r = file->pgWrite(&buf[0], off, size, csp, op->opts);
+        break;
+      case opPgRead:
+        r = file->pgRead(&buf[0], off, size, csp, op->opts);
+        break;
+      case opReadV:
+        r = file->ReadV(&iov[0], iov.size());
+        break;
+      default:
+        break;
+    }
+    const std::chrono::steady_clock::time_point t1 =
+                                          std::chrono::steady_clock::now();
+    if (r < 0 || (size_t)r != expect) {
+      res->err = (r < 0) ? (int)r : -EIO;
+      break;
+    }
+    res->bytes += r;
+    res->lat.push_back(
+       std::chrono::duration<double, std::micro>(t1 - t0).count());
+  }
+  res->end = std::chrono::steady_clock::now();
+  file->Close();
+}
+
+void Bench::metaThread(const BenchOp *op, int idx, size_t niter,
+                       ThreadResult *res) {
+  res->bytes = 0;
+  res->err = 0;
+  res->files = 0;
+  res->lat.reserve(niter);
+
+  std::string tid = "benchtid" + std::to_string((long long)idx);
+  std::unique_ptr<XrdOssDF> file(m_oss->newFile(tid.c_str()));
+  const std::string fn = metaFn(idx);
+
+  if (op->type == opCreate) {
+    for(size_t i=0;i<niter && !res->err;i++) {
+      if (mkdir(createDir(idx, i).c_str(), 0700)) res->err = -errno;
+    }
+  }
+
+  m_ready++;
+  while(!m_go) std::this_thread::yield();
+  if (res->err) {
+    res->end = std::chrono::steady_clock::now();
+    return;
+  }
+
+  for(size_t i=0;i<niter;i++) {
+    const std::chrono::steady_clock::time_point t0 =
+                                          std::chrono::steady_clock::now();
+    int r = 0;
+    switch(op->type) {
+      case opOpen:
+        r = file->Open(fn.c_str(), O_RDWR, 0600, m_env);
+        if (r == XrdOssOK) r = file->Close();
+        break;
+      case opCreate:
+        r = file->Open(createFn(idx, i).c_str(), O_RDWR|O_CREAT|O_TRUNC,
+                       0600, m_env);
+        if (r == XrdOssOK) {
+          res->files++;
+          r = file->Close();
+        }
+        break;
+      default:
+        break;
+    }
+    const std::chrono::steady_clock::time_point t1 =
+                                          std::chrono::steady_clock::now();
+    if (r != XrdOssOK) {
+      res->err = r;
+      break;
+    }
+    res->lat.push_back(
+       std::chrono::duration<double, std::micro>(t1 - t0).count());
+  }
+  res->end = std::chrono::steady_clock::now();
+}
+
+std::string Bench::createDir(int idx, size_t i) {
+  return m_cfg.fn + ".d" + std::to_string((long long)idx) + "." +
+         std::to_string((unsigned long long)i);
+}
+
+std::string Bench::createFn(int idx, size_t i) {
+  return createDir(idx, i) + "/f";
+}
+
+void Bench::cleanupCreate(int idx, size_t ndirs, size_t nfiles) {
+  for(size_t i=0;i<ndirs;i++) {
+    if (i < nfiles) m_oss->Unlink(createFn(idx, i).c_str());
+    m_oss->Remdir(createDir(idx, i).c_str());
+  }
+}
+
+std::string Bench::metaFn(int idx) {
+  if (m_cfg.shared) return m_cfg.fn;
+  return m_cfg.fn + "." + std::to_string((long long)idx);
+}
+
+int Bench::populateMeta(int nthr) {
+  uint8_t buf[PGSZ];
+  memset(buf, 0x5a, sizeof(buf));
+  for(int i=0;i<(m_cfg.shared ? 1 : nthr);i++) {
+    std::unique_ptr<XrdOssDF> file(m_oss->newFile("benchtid"));
+    int ret = file->Open(metaFn(i).c_str(), O_RDWR|O_CREAT|O_TRUNC, 0600,
+                         m_env);
+    if (ret != XrdOssOK) return ret;
+    ssize_t r = file->Write(buf, 0, sizeof(buf));
+    file->Close();
+    if (r != (ssize_t)sizeof(buf)) return (r < 0) ? (int)r : -EIO;
+  }
+  return 0;
+}
+
+void Bench::cleanupMeta(int nthr) {
+  for(int i=0;i<(m_cfg.shared ? 1 : nthr);i++) {
+    m_oss->Unlink(metaFn(i).c_str());
+  }
+}
+
+int Bench::populate(size_t size, int nthr) {
+  std::unique_ptr<XrdOssDF> file(m_oss->newFile("benchtid"));
+  int ret = file->Open(m_cfg.fn.c_str(), O_RDWR|O_CREAT|O_TRUNC, 0600, m_env);
+  if (ret != XrdOssOK) return ret;
+
+  const size_t chunk = 8*1024*1024;
+  std::unique_ptr<uint8_t[]> buf(new uint8_t[chunk]);
+  memset(&buf[0], 0x5a, chunk);
+  const off_t flen = nthr * regionSpan(size);
+  for(off_t off=0;off<flen;off+=chunk) {
+    const size_t wlen = std::min((off_t)chunk, flen - off);
+    ssize_t r = file->Write(&buf[0], off, wlen);
+    if (r < 0 || (size_t)r != wlen) {
+      file->Close();
+      return (r < 0) ? (int)r : -EIO;
+    }
+  }
+  return file->Close();
+}
+
+int Bench::runCase(const BenchOp *op, size_t size, size_t pageoff, int nthr) {
+  size_t niter = m_cfg.metaIter;
+  if (!isMeta(op)) {
+    // the budget is shared between the threads of a case
+    niter = m_cfg.budget / ((size_t)nthr * size);
+    niter = std::max(niter, m_cfg.minIter);
+    niter = std::min(niter, (size_t)100000);
+  }
+
+  std::vector<ThreadResult> res(nthr);
+  std::vector<std::thread> thr;
+  m_ready = 0;
+  m_go = false;
+  for(int i=0;i<nthr;i++) {
+    if (isMeta(op)) {
+      thr.emplace_back(&Bench::metaThread, this, op, i, niter, &res[i]);
+    } else {
+      thr.emplace_back(&Bench::thread, this, op, size, pageoff, i, niter,
+                       &res[i]);
+    }
+  }
+  while(m_ready < nthr) std::this_thread::yield();
+  const std::chrono::steady_clock::time_point t0 =
+                                          std::chrono::steady_clock::now();
+  m_go = true;
+  // throughput is taken up to the end of the last thread's timed loop,
+  // so it does not include the Close and thread teardown
+  std::chrono::steady_clock::time_point t1 = t0;
+  for(int i=0;i<nthr;i++) {
+    thr[i].join();
+    t1 = std::max(t1, res[i].end);
+  }
+  const double secs = std::chrono::duration<double>(t1 - t0).count();
+
+  if (op->type == opCreate) {
+    for(int i=0;i<nthr;i++) {
+      cleanupCreate(i, niter, res[i].files);
+    }
+  }
+
+  std::vector<double> lat;
+  size_t bytes = 0;
+  for(int i=0;i<nthr;i++) {
+    if (res[i].err) {
+      fprintf(stderr, "%s %s size=%zu off=%zu threads=%d: error %d\n",
+              m_name, op->name, size, pageoff, nthr, res[i].err);
+      return res[i].err;
+    }
+    bytes += res[i].bytes;
+    lat.insert(lat.end(), res[i].lat.begin(), res[i].lat.end());
+  }
+  std::sort(lat.begin(), lat.end());
+  const double p50 = lat[lat.size() / 2];
+  const double p99 = lat[std::min(lat.size() - 1, (lat.size() * 99) / 100)];
+
+  char mbs[32];
+  snprintf(mbs, sizeof(mbs), "%.1f", bytes / secs / 1e6);
+  printf("%-5s %-16s %-9s %-6s %6s %4d %10s %10.0f %12.1f %12.1f\n",
+         m_name, op->name,
+         isMeta(op) ? "-" : (pageoff ? "unaligned" : "aligned"),
+         m_cfg.shared ? "shared" : "own",
+         isMeta(op) ? "-" : sizeStr(size).c_str(), nthr,
+         isMeta(op) ? "-" : mbs, lat.size() / secs, p50, p99);
+  fflush(stdout);
+  return 0;
+}
+
+int Bench::run() {
+  std::vector<const BenchOp*> dataOps, metaOps;
+  for(size_t o=0;o<m_cfg.ops.size();o++) {
+    if (isMeta(m_cfg.ops[o])) {
+      metaOps.push_back(m_cfg.ops[o]);
+    } else {
+      dataOps.push_back(m_cfg.ops[o]);
+    }
+  }
+
+  for(size_t s=0;s<m_cfg.sizes.size() && !dataOps.empty();s++) {
+    for(size_t t=0;t<m_cfg.threads.size();t++) {
+      const size_t size = m_cfg.sizes[s];
+      const int nthr = m_cfg.threads[t];
+      int ret = populate(size, nthr);
+      if (ret) {
+        fprintf(stderr, "%s: could not create %s: error %d\n",
+                m_name, m_cfg.fn.c_str(), ret);
+        return ret;
+      }
+      for(size_t a=0;a<m_cfg.pageoffs.size();a++) {
+        for(size_t o=0;o<dataOps.size();o++) {
+          ret = runCase(dataOps[o], size, m_cfg.pageoffs[a], nthr);
+          if (ret) return ret;
+        }
+      }
+    }
+    m_oss->Unlink(m_cfg.fn.c_str());
+  }
+
+  for(size_t t=0;t<m_cfg.threads.size() && !metaOps.empty();t++) {
+    const int nthr = m_cfg.threads[t];
+    int ret = populateMeta(nthr);
+    if (ret) {
+      fprintf(stderr, "%s: could not create %s: error %d\n",
+              m_name, metaFn(0).c_str(), ret);
+      cleanupMeta(nthr);
+      return ret;
+    }
+    for(size_t o=0;o<metaOps.size() && !ret;o++) {
+      ret = runCase(metaOps[o], 0, 0, nthr);
+    }
+    cleanupMeta(nthr);
+    if (ret) return ret;
+  }
+  return 0;
+}
+
+void usage(const char *prog) {
+  fprintf(stderr,
+    "usage: %s [-o ops] [-s sizes] [-t threads] [-a aligned|unaligned|both]\n"
+    "          [-x csi,base] [-m MiB per case] [-n min iterations]\n"
+    "          [-N open/create iterations] [-f file]\n"
+    "          [-p plugin parameters] [-S]\n"
+    "ops:", prog);
+  for(size_t i=0;i<sizeof(benchOps)/sizeof(benchOps[0]);i++) {
+    fprintf(stderr, " %s", benchOps[i].name);
+  }
+  fprintf(stderr, "\n");
+}
+
+} // anonymous namespace
+
+int main(int argc, char** argv) {
+  BenchConfig cfg;
+  const char *ops = NULL;
+  const char *sizes = "1,512,4k,32k,256k,1m,8m,64m";
+  const char *threads = "1,4";
+  const char *align = "both";
+  const char *which = "csi,base";
+  cfg.budget = 64*1024*1024;
+  cfg.minIter = 16;
+  cfg.metaIter = 2000;
+  cfg.fn = TMPFN;
+  cfg.params = "prefix=";
+  cfg.shared = false;
+
+  int c;
+  while((c = getopt(argc, argv, "o:s:t:a:x:m:n:N:f:p:Sh")) != -1) {
+    switch(c) {
+      case 'o': ops = optarg; break;
+      case 's': sizes = optarg; break;
+      case 't': threads = optarg; break;
+      case 'a': align = optarg; break;
+      case 'x': which = optarg; break;
+      case 'm': cfg.budget = strtoull(optarg, NULL, 10) << 20; break;
+      case 'n': cfg.minIter = std::max(1, atoi(optarg)); break;
+      case 'N': cfg.metaIter = std::max(1, atoi(optarg)); break;
+      case 'f': cfg.fn = optarg; break;
+      case 'p': cfg.params = optarg; break;
+      case 'S': cfg.shared = true; break;
+      default: usage(argv[0]); return 1;
+    }
+  }
+
+  const size_t nops = sizeof(benchOps)/sizeof(benchOps[0]);
+  if (ops) {
+    std::vector<std::string> v = splitList(ops);
+    for(size_t i=0;i<nops;i++) {
+      if (std::find(v.begin(), v.end(), benchOps[i].name) != v.end()) {
+        cfg.ops.push_back(&benchOps[i]);
+      }
+    }
+  } else {
+    for(size_t i=0;i<nops;i++) cfg.ops.push_back(&benchOps[i]);
+  }
+
+  std::vector<std::string> v = splitList(sizes);
+  for(size_t i=0;i<v.size();i++) {
+    const size_t s = parseSize(v[i].c_str());
+    if (s > 0) cfg.sizes.push_back(s);
+  }
+  v = splitList(threads);
+  for(size_t i=0;i<v.size();i++) {
+    const int n = atoi(v[i].c_str());
+    if (n > 0) cfg.threads.push_back(n);
+  }
+  if (strcmp(align, "unaligned")) cfg.pageoffs.push_back(0);
+  if (strcmp(align, "aligned")) cfg.pageoffs.push_back(UNALIGNED_OFF);
+  v = splitList(which);
+  cfg.runCsi = std::find(v.begin(), v.end(), "csi") != v.end();
+  cfg.runBase = std::find(v.begin(), v.end(), "base") != v.end();
+
+  if (cfg.ops.empty() || cfg.sizes.empty() || cfg.threads.empty()) {
+    usage(argv[0]);
+    return 1;
+  }
+
+#ifndef __OPTIMIZE__
+  fprintf(stderr, "warning: bench_csi was built without optimisation; "
+                  "configure with -DBUILD_BENCH=1 for meaningful numbers\n");
+#endif
+
+  int fdnull = open("/dev/null", O_WRONLY);
+  if (fdnull < 0) return 1;
+  XrdSysLogger logger(fdnull, 0);
+
+  const char *config_fn = NULL;
+  XrdVERSIONINFODEF(ver, "benchcsi", XrdVNUMBER,XrdVERSION);
+  XrdOss *ossP = XrdOssDefaultSS(&logger, config_fn, ver);
+  if (!ossP) {
+    fprintf(stderr, "could not load the default oss\n");
+    return 1;
+  }
+
+  void *libp = dlopen("libXrdOssCsi-5.so",RTLD_NOW|RTLD_GLOBAL);
+  if (!libp) {
+    fprintf(stderr, "%s\n", dlerror());
+    return 1;
+  }
+
+  XrdOssAddStorageSystem2_t oss2P=NULL;
+  oss2P = reinterpret_cast<XrdOssAddStorageSystem2_t>(dlsym(libp, "XrdOssAddStorageSystem2"));
+  if (!oss2P) {
+    fprintf(stderr, "%s\n", dlerror());
+    return 1;
+  }
+
+  XrdOucEnv env;
+  XrdOss *csiP = oss2P(ossP, &logger, config_fn, cfg.params.c_str(), &env);
+  if (!csiP || (csiP->Features() & XRDOSS_HASFSCS) == 0) {
+    fprintf(stderr, "could not load the XrdOssCsi plugin\n");
+    return 1;
+  }
+
+  printf("%-5s %-16s %-9s %-6s %6s %4s %10s %10s %12s %12s\n",
+         "oss", "op", "align", "region", "size", "thr", "MB/s", "ops/s",
+         "p50(us)", "p99(us)");
+
+  int ret = 0;
+  if (cfg.runCsi) {
+    Bench b(csiP, "csi", cfg);
+    ret = b.run();
+  }
+  if (!ret && cfg.runBase) {
+    BenchConfig bcfg = cfg;
+    bcfg.fn += ".base";
+    Bench b(ossP, "base", bcfg);
+    ret = b.run();
+  }
+
+  delete csiP;
+  dlclose(libp);
+  close(fdnull);
+  return ret ? 1 : 0;
+}
@@ -31,12 +31,14 @@
 #include "XrdOuc/XrdOucCRC.hh"
 #include "XrdOss/XrdOssDefaultSS.hh"
 #include "XrdOuc/XrdOucEnv.hh"
+#include "XrdOuc/XrdOucIOVec.hh"
 #include "XrdSys/XrdSysLogger.hh"
 #include "XrdVersion.hh"
 
 #include <gtest/gtest.h>
 
 #include <iostream>
+#include <memory>
 #include <dlfcn.h>
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -329,6 +331,32 @@ TEST_F(osscsi_pageTest,extendwrite) {
   ASSERT_TRUE(memcmp(cbuf,rbuf,16484)==0);
 }
 
+TEST_F(osscsi_pageTest,largehole) {
+  ssize_t ret = m_file->Write(m_b, 0, 100);
+  ASSERT_TRUE(ret == 100);
+  const size_t npages = 1000;
+  ret = m_file->Write(&m_b[4096], npages*4096 + 10, 10);
+  ASSERT_TRUE(ret == 10);
+  std::unique_ptr<uint8_t[]> rbuf(new uint8_t[(npages+1)*4096]);
+  std::unique_ptr<uint32_t[]> csvec(new uint32_t[npages+1]);
+  ret = m_file->pgRead(&rbuf[0], 0, (npages+1)*4096, &csvec[0], XrdOssDF::Verify);
+  ASSERT_TRUE(ret == (ssize_t)(npages*4096 + 20));
+  uint8_t cbuf[4096];
+  memset(cbuf,0,4096);
+  memcpy(cbuf,m_b,100);
+  ASSERT_TRUE(memcmp(&rbuf[0],cbuf,4096)==0);
+  ASSERT_TRUE(csvec[0] == XrdOucCRC::Calc32C(cbuf, 4096, 0u));
+  memset(cbuf,0,4096);
+  const uint32_t zcrc = XrdOucCRC::Calc32C(cbuf, 4096, 0u);
+  for(size_t i=1;i<npages;i++) {
+    ASSERT_TRUE(memcmp(&rbuf[i*4096],cbuf,4096)==0);
+    ASSERT_TRUE(csvec[i] == zcrc);
+  }
+  memcpy(&cbuf[10],&m_b[4096],10);
+  ASSERT_TRUE(memcmp(&rbuf[npages*4096],cbuf,20)==0);
+  ASSERT_TRUE(csvec[npages] == XrdOucCRC::Calc32C(cbuf, 20, 0u));
+}
+
 TEST_F(osscsi_pageTest,badcrc) {
   uint32_t csvec[4] = { 0x1, 0x2, 0x3, 0x4 };
   ssize_t ret = m_file->pgWrite(m_b, 0, 16384, csvec, XrdOssDF::Verify);
@@ -377,6 +405,38 @@ TEST_F(osscsi_pageTest,badcrc) {
   ASSERT_TRUE(memcmp(csvec,&csvec2[1],3*4)==0);
 }
 
+TEST_F(osscsi_pageTest,readv) {
+  ssize_t ret = m_file->Write(m_b, 0, 16384);
+  ASSERT_TRUE(ret == 16384);
+  uint8_t rbuf[16384];
+  XrdOucIOVec iov[4] = {};
+  iov[0].offset = 100;   iov[0].size = 50;   iov[0].data = (char*)&rbuf[0];
+  iov[1].offset = 4000;  iov[1].size = 300;  iov[1].data = (char*)&rbuf[50];
+  iov[2].offset = 4050;  iov[2].size = 10;   iov[2].data = (char*)&rbuf[350];
+  iov[3].offset = 12000; iov[3].size = 4384; iov[3].data = (char*)&rbuf[360];
+  ret = m_file->ReadV(iov, 4);
+  ASSERT_TRUE(ret == 4744);
+  ASSERT_TRUE(memcmp(&rbuf[0], &m_b[100], 50)==0);
+  ASSERT_TRUE(memcmp(&rbuf[50], &m_b[4000], 300)==0);
+  ASSERT_TRUE(memcmp(&rbuf[350], &m_b[4050], 10)==0);
+  ASSERT_TRUE(memcmp(&rbuf[360], &m_b[12000], 4384)==0);
+
+  uint32_t badcrc = 0x1;
+  ret = m_file->pgWrite(&m_b[4096], 4096, 4096, &badcrc, 0);
+  ASSERT_TRUE(ret == 4096);
+  ret = m_file->ReadV(iov, 4);
+  ASSERT_TRUE(ret == -EDOM);
+  iov[1].offset = 0;     iov[1].size = 4096; iov[1].data = (char*)&rbuf[50];
+  iov[2].offset = 8192;  iov[2].size = 10;   iov[2].data = (char*)&rbuf[4146];
+  iov[3].offset = 12000; iov[3].size = 4384; iov[3].data = (char*)&rbuf[4156];
+  ret = m_file->ReadV(iov, 4);
+  ASSERT_TRUE(ret == 8540);
+  ASSERT_TRUE(memcmp(&rbuf[0], &m_b[100], 50)==0);
+  ASSERT_TRUE(memcmp(&rbuf[50], m_b, 4096)==0);
+  ASSERT_TRUE(memcmp(&rbuf[4146], &m_b[8192], 10)==0);
+  ASSERT_TRUE(memcmp(&rbuf[4156], &m_b[12000], 4384)==0);
+}
+
 TEST_F(osscsi_pageTest,truncate) {
   ssize_t ret = m_file->Ftruncate(16384);
   ASSERT_TRUE(ret == 0);